@@ -1,7 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <pthread.h>
+#include <zlib.h>
+#include <zstd.h>
+#include "libcsv.h"
+
+// Tamanho de cada bloco lido/descomprimido e quantidade de blocos em trânsito entre as threads
+#define CSV_CHUNK_SIZE 65536
+#define CSV_PIPE_SLOTS 4
 
 // Mutex para garantir a segurança entre threads
 pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -13,6 +21,76 @@ typedef struct {
     char *value;
 } Filter;
 
+// Estado de uma consulta (colunas selecionadas e filtros) aplicada linha a linha
+typedef struct {
+    char **headers;
+    int headerCount;
+    char **selectedCols;
+    int selectedCount;
+    Filter *filters;
+    int filterCount;
+} CsvQuery;
+
+// Formatos de arquivo reconhecidos pelos magic bytes
+typedef enum {
+    CSV_PLAIN,
+    CSV_GZIP,
+    CSV_ZSTD
+} CsvCompression;
+
+// Arquivo de entrada e o descompressor correspondente
+typedef struct {
+    FILE *file;
+    CsvCompression compression;
+    unsigned char *in;
+    size_t inLength;
+    size_t inPosition;
+    int streamEnded;
+    z_stream gzip;
+    int gzipReady;
+    ZSTD_DStream *zstd;
+} CsvSource;
+
+// Fila limitada de blocos descomprimidos entre a thread produtora e a consumidora
+typedef struct {
+    CsvSource *source;
+    char *slots[CSV_PIPE_SLOTS];
+    long lengths[CSV_PIPE_SLOTS];
+    int head;
+    int count;
+    int acquired;
+    int done;
+    int failed;
+    int cancelled;
+    int threaded;
+    int syncReady;
+    pthread_t producer;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+} CsvPipe;
+
+// Tabela carregada em memória: um único buffer com os campos terminados em '\0' e os offsets de cada campo por linha
+struct CsvTable {
+    char *data;
+    size_t length;
+    char **headers;
+    int headerCount;
+    size_t *offsets;
+    int rowCount;
+    double **numericColumns;
+    pthread_mutex_t lock;
+};
+
+// Consulta preparada: filtros já extraídos e índices das colunas selecionadas na ordem do CSV
+struct CsvTableQuery {
+    const CsvTable *table;
+    Filter *filters;
+    int filterCount;
+    int *columns;
+    int columnCount;
+};
+
 // Declaração das funções auxiliares
 char **splitString(const char *str, const char *delimiter, int *count);
 void freeSplitString(char **split, int count);
@@ -21,7 +99,22 @@ int isValidColumn(char **headers, int headerCount, const char *column, char *err
 int isValidFilter(char **headers, int headerCount, const char *filter, char *errorBuffer);
 Filter *extractFilters(const char *filterStr, char **headers, int headerCount, int *filterCount);
 void freeFilters(Filter *filters, int filterCount);
+int filterMatches(const Filter *filter, const char *value);
 int rowMatchesFilters(char **headers, char **row, Filter *filters, int filterCount,  int headerCount);
+int beginCsvQuery(CsvQuery *query, const char *headerLine, const char selectedColumns[], const char rowFilterDefinitions[]);
+void processCsvRow(CsvQuery *query, const char *line);
+void endCsvQuery(CsvQuery *query);
+CsvCompression detectCompression(const unsigned char *data, size_t length);
+int openCsvSource(CsvSource *source, const char *csvFilePath);
+int fillCsvSource(CsvSource *source);
+long readCsvSource(CsvSource *source, char *buffer, size_t capacity);
+void closeCsvSource(CsvSource *source);
+void *csvPipeProducer(void *arg);
+int openCsvPipe(CsvPipe *pipe, CsvSource *source);
+long nextCsvPipeChunk(CsvPipe *pipe, char **chunk);
+void closeCsvPipe(CsvPipe *pipe);
+int splitFieldsInPlace(char *data, size_t start, size_t end, size_t *offsets, int maxFields);
+CsvTable *buildCsvTable(char *data, size_t length);
 
 
 // Função auxiliar para dividir uma string em partes com base em um delimitador
@@ -212,6 +305,26 @@ void freeFilters(Filter *filters, int filterCount) {
     free(filters);
 }
 
+// Compara um valor com o filtro. Retorna 1 se corresponder, 0 se não corresponder ou -1 para operador inválido
+int filterMatches(const Filter *filter, const char *value) {
+    int comparison = strcmp(value, filter->value);
+
+    if (strcmp(filter->operation, ">=") == 0) {
+        return comparison >= 0;
+    } else if (strcmp(filter->operation, "<=") == 0) {
+        return comparison <= 0;
+    } else if (filter->operation[0] == '>') {
+        return comparison > 0;
+    } else if (filter->operation[0] == '<') {
+        return comparison < 0;
+    } else if (filter->operation[0] == '=') {
+        return comparison == 0;
+    } else if (filter->operation[0] == '!') {
+        return comparison != 0;
+    }
+    return -1;
+}
+
 // Função auxiliar para verificar se uma linha atende aos filtros
 int rowMatchesFilters(char **headers, char **row, Filter *filters, int filterCount, int headerCount) {
     // printf("Debugging rowMatchesFilters:\n");
@@ -223,21 +336,9 @@ int rowMatchesFilters(char **headers, char **row, Filter *filters, int filterCou
     for (int i = 0; i < filterCount; i++) {
         int columnIndex = filters[i].columnIndex;
         char *rowValue = row[columnIndex];
-        int match = 0;
-
-        if (strcmp(filters[i].operation, ">=") == 0) {
-            match = (strcmp(rowValue, filters[i].value) >= 0);
-        } else if (strcmp(filters[i].operation, "<=") == 0) {
-            match = (strcmp(rowValue, filters[i].value) <= 0);
-        } else if (filters[i].operation[0] == '>') {
-            match = (strcmp(rowValue, filters[i].value) > 0);
-        } else if (filters[i].operation[0] == '<') {
-            match = (strcmp(rowValue, filters[i].value) < 0);
-        } else if (filters[i].operation[0] == '=') {
-            match = (strcmp(rowValue, filters[i].value) == 0);
-        } else if (filters[i].operation[0] == '!') {
-            match = (strcmp(rowValue, filters[i].value) != 0);
-        } else {
+        int match = filterMatches(&filters[i], rowValue);
+
+        if (match < 0) {
             fprintf(stderr, "Invalid filter: '%s%c%s'\n", headers[columnIndex], filters[i].operation[0], filters[i].value);
             free(columnMatches);
             return 0;
@@ -262,115 +363,738 @@ int rowMatchesFilters(char **headers, char **row, Filter *filters, int filterCou
     return 1;
 }
 
+// Prepara a consulta a partir da linha de cabeçalho: valida colunas e filtros e imprime os headers selecionados
+int beginCsvQuery(CsvQuery *query, const char *headerLine, const char selectedColumns[], const char rowFilterDefinitions[]) {
+    memset(query, 0, sizeof(CsvQuery));
+
+    query->headers = splitString(headerLine, ",", &query->headerCount);
+    if (!query->headers) return 0;
+
+    if (strlen(selectedColumns) == 0) {
+        query->selectedCols = query->headers;
+        query->selectedCount = query->headerCount;
+    } else {
+        query->selectedCols = splitString(selectedColumns, ",", &query->selectedCount);
+    }
+
+    char errorBuffer[1024] = {0};
+    validateHeadersAndFilters(selectedColumns, rowFilterDefinitions, query->headers, query->headerCount, errorBuffer);
+
+    if (strlen(errorBuffer) > 0) {
+        fprintf(stderr, "%s", errorBuffer);
+        endCsvQuery(query);
+        return 0;
+    }
+
+    query->filters = extractFilters(rowFilterDefinitions, query->headers, query->headerCount, &query->filterCount);
+    if (!query->filters) {
+        endCsvQuery(query);
+        return 0;
+    }
+
+    // Imprime os headers selecionados na ordem do CSV
+    int printedHeaders = 0;
+    for (int j = 0; j < query->headerCount; j++) {
+        for (int k = 0; k < query->selectedCount; k++) {
+            if (strcmp(query->headers[j], query->selectedCols[k]) == 0) {
+                if (printedHeaders > 0) printf(",");
+                printf("%s", query->headers[j]);
+                printedHeaders++;
+                break;
+            }
+        }
+    }
+    printf("\n");
+    return 1;
+}
+
+// Aplica os filtros a uma linha de dados e imprime as colunas selecionadas caso ela seja aceita
+void processCsvRow(CsvQuery *query, const char *line) {
+    int rowColumnCount;
+    char **row = splitString(line, ",", &rowColumnCount);
+    if (!row) return;
+
+    if (!rowMatchesFilters(query->headers, row, query->filters, query->filterCount, query->headerCount)) {
+        freeSplitString(row, rowColumnCount);
+        return;
+    }
+
+    // Imprime os valores da linha na ordem dos headers, selecionados
+    int printedValues = 0;
+    for (int j = 0; j < query->headerCount; j++) {
+        for (int k = 0; k < query->selectedCount; k++) {
+            if (strcmp(query->headers[j], query->selectedCols[k]) == 0) {
+                if (printedValues > 0) printf(",");
+                printf("%s", row[j]);
+                printedValues++;
+                break;
+            }
+        }
+    }
+    printf("\n");
+    freeSplitString(row, rowColumnCount);
+}
+
+// Libera a memória alocada pela consulta
+void endCsvQuery(CsvQuery *query) {
+    if (query->selectedCols && query->selectedCols != query->headers) freeSplitString(query->selectedCols, query->selectedCount);
+    if (query->headers) freeSplitString(query->headers, query->headerCount);
+    if (query->filters) freeFilters(query->filters, query->filterCount);
+    memset(query, 0, sizeof(CsvQuery));
+}
+
 // função para processar string Csv
 void processCsv(const char csv[], const char selectedColumns[], const char rowFilterDefinitions[]) {
     pthread_mutex_lock(&mutex);
 
-    int headerCount, rowCount, selectedCount, filterCount;
+    int rowCount;
     char **rows = splitString(csv, "\n", &rowCount);
     if (!rows) {
         pthread_mutex_unlock(&mutex);
         return;
     }
 
-    char **headers = splitString(rows[0], ",", &headerCount);
-    char **selectedCols;
-    if (strlen(selectedColumns) == 0) {
-        selectedCols = headers;
-        selectedCount = headerCount;
+    CsvQuery query;
+    if (rowCount > 0 && beginCsvQuery(&query, rows[0], selectedColumns, rowFilterDefinitions)) {
+        for (int i = 1; i < rowCount; i++) {
+            processCsvRow(&query, rows[i]);
+        }
+        endCsvQuery(&query);
+    }
+
+    freeSplitString(rows, rowCount);
+    pthread_mutex_unlock(&mutex);
+}
+
+// Identifica o formato do arquivo pelos primeiros bytes já lidos para o buffer de entrada
+CsvCompression detectCompression(const unsigned char *data, size_t length) {
+    if (length >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        return CSV_GZIP;
+    }
+    if (length >= 4 && data[0] == 0x28 && data[1] == 0xb5 && data[2] == 0x2f && data[3] == 0xfd) {
+        return CSV_ZSTD;
+    }
+    return CSV_PLAIN;
+}
+
+// Abre o arquivo e inicializa o descompressor adequado
+int openCsvSource(CsvSource *source, const char *csvFilePath) {
+    memset(source, 0, sizeof(CsvSource));
+
+    source->file = fopen(csvFilePath, "rb");
+    if (!source->file) {
+        perror("Unable to open file");
+        return 0;
+    }
+
+    source->in = (unsigned char *)malloc(CSV_CHUNK_SIZE);
+    if (!source->in) {
+        closeCsvSource(source);
+        return 0;
+    }
+
+    if (fillCsvSource(source) < 0) {
+        perror("Unable to read file");
+        closeCsvSource(source);
+        return 0;
+    }
+    source->compression = detectCompression(source->in, source->inLength);
+
+    if (source->compression == CSV_GZIP) {
+        // 15 + 16: janela máxima, aceitando apenas o cabeçalho gzip
+        if (inflateInit2(&source->gzip, 15 + 16) != Z_OK) {
+            fprintf(stderr, "Unable to decompress file '%s'\n", csvFilePath);
+            closeCsvSource(source);
+            return 0;
+        }
+        source->gzipReady = 1;
+    } else if (source->compression == CSV_ZSTD) {
+        source->zstd = ZSTD_createDStream();
+        if (!source->zstd || ZSTD_isError(ZSTD_initDStream(source->zstd))) {
+            fprintf(stderr, "Unable to decompress file '%s'\n", csvFilePath);
+            closeCsvSource(source);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Garante que existam bytes pendentes no buffer de entrada (1), fim de arquivo (0) ou erro de leitura (-1)
+int fillCsvSource(CsvSource *source) {
+    if (source->inPosition < source->inLength) return 1;
+
+    source->inLength = fread(source->in, 1, CSV_CHUNK_SIZE, source->file);
+    source->inPosition = 0;
+    if (source->inLength == 0) {
+        return ferror(source->file) ? -1 : 0;
+    }
+    return 1;
+}
+
+// Lê até capacity bytes já descomprimidos. Retorna a quantidade lida, 0 no fim do arquivo ou -1 em caso de erro
+long readCsvSource(CsvSource *source, char *buffer, size_t capacity) {
+    if (source->compression == CSV_PLAIN) {
+        // Entrega primeiro os bytes lidos na detecção do formato; depois lê direto no buffer do chamador
+        if (source->inPosition < source->inLength) {
+            size_t length = source->inLength - source->inPosition;
+            if (length > capacity) length = capacity;
+            memcpy(buffer, source->in + source->inPosition, length);
+            source->inPosition += length;
+            return (long)length;
+        }
+
+        size_t length = fread(buffer, 1, capacity, source->file);
+        if (length == 0) {
+            return ferror(source->file) ? -1 : 0;
+        }
+        return (long)length;
+    }
+
+    if (source->compression == CSV_GZIP) {
+        source->gzip.next_out = (Bytef *)buffer;
+        source->gzip.avail_out = (uInt)capacity;
+
+        while (source->gzip.avail_out == capacity) {
+            int status = fillCsvSource(source);
+            if (status < 0) return -1;
+            // Fim do arquivo só é válido se o último membro gzip foi concluído
+            if (status == 0) return source->streamEnded ? 0 : -1;
+
+            source->gzip.next_in = source->in + source->inPosition;
+            source->gzip.avail_in = (uInt)(source->inLength - source->inPosition);
+            source->streamEnded = 0;
+
+            int ret = inflate(&source->gzip, Z_NO_FLUSH);
+            source->inPosition = source->inLength - source->gzip.avail_in;
+
+            if (ret == Z_STREAM_END) {
+                // Arquivos gzip podem conter vários membros concatenados
+                inflateReset(&source->gzip);
+                source->streamEnded = 1;
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                return -1;
+            }
+        }
+        return (long)(capacity - source->gzip.avail_out);
+    }
+
+    ZSTD_outBuffer output = {buffer, capacity, 0};
+    while (output.pos == 0) {
+        int status = fillCsvSource(source);
+        if (status < 0) return -1;
+        // Fim do arquivo só é válido se o último frame zstd foi concluído
+        if (status == 0) return source->streamEnded ? 0 : -1;
+
+        ZSTD_inBuffer input = {source->in, source->inLength, source->inPosition};
+        size_t ret = ZSTD_decompressStream(source->zstd, &output, &input);
+        source->inPosition = input.pos;
+        if (ZSTD_isError(ret)) return -1;
+        source->streamEnded = (ret == 0);
+    }
+    return (long)output.pos;
+}
+
+// Fecha o arquivo e libera os recursos do descompressor
+void closeCsvSource(CsvSource *source) {
+    if (source->gzipReady) inflateEnd(&source->gzip);
+    if (source->zstd) ZSTD_freeDStream(source->zstd);
+    if (source->file) fclose(source->file);
+    free(source->in);
+    memset(source, 0, sizeof(CsvSource));
+}
+
+// Thread produtora: descomprime o arquivo em blocos enquanto a thread principal filtra as linhas
+void *csvPipeProducer(void *arg) {
+    CsvPipe *pipe = (CsvPipe *)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&pipe->lock);
+        while (pipe->count == CSV_PIPE_SLOTS && !pipe->cancelled) {
+            pthread_cond_wait(&pipe->notFull, &pipe->lock);
+        }
+        if (pipe->cancelled) {
+            pthread_mutex_unlock(&pipe->lock);
+            break;
+        }
+        int slot = (pipe->head + pipe->count) % CSV_PIPE_SLOTS;
+        pthread_mutex_unlock(&pipe->lock);
+
+        // O slot livre pertence apenas ao produtor até ser publicado
+        long length = readCsvSource(pipe->source, pipe->slots[slot], CSV_CHUNK_SIZE);
+
+        pthread_mutex_lock(&pipe->lock);
+        if (length <= 0) {
+            pipe->failed = (length < 0);
+            pipe->done = 1;
+            pthread_cond_signal(&pipe->notEmpty);
+            pthread_mutex_unlock(&pipe->lock);
+            break;
+        }
+        pipe->lengths[slot] = length;
+        pipe->count++;
+        pthread_cond_signal(&pipe->notEmpty);
+        pthread_mutex_unlock(&pipe->lock);
+    }
+    return NULL;
+}
+
+// Inicializa o pipe; arquivos comprimidos são lidos por uma thread própria quando possível
+int openCsvPipe(CsvPipe *pipe, CsvSource *source) {
+    memset(pipe, 0, sizeof(CsvPipe));
+    pipe->source = source;
+
+    // A leitura síncrona usa apenas o primeiro slot
+    pipe->slots[0] = (char *)malloc(CSV_CHUNK_SIZE);
+    if (!pipe->slots[0]) return 0;
+
+    if (source->compression == CSV_PLAIN) return 1;
+
+    // Sem memória para o anel, a descompressão segue de forma síncrona
+    for (int i = 1; i < CSV_PIPE_SLOTS; i++) {
+        pipe->slots[i] = (char *)malloc(CSV_CHUNK_SIZE);
+        if (!pipe->slots[i]) return 1;
+    }
+
+    pthread_mutex_init(&pipe->lock, NULL);
+    pthread_cond_init(&pipe->notEmpty, NULL);
+    pthread_cond_init(&pipe->notFull, NULL);
+    pipe->syncReady = 1;
+
+    // Sem thread disponível, a descompressão segue de forma síncrona
+    pipe->threaded = (pthread_create(&pipe->producer, NULL, csvPipeProducer, pipe) == 0);
+    return 1;
+}
+
+// Obtém o próximo bloco de dados. Retorna o tamanho, 0 no fim do arquivo ou -1 em caso de erro
+long nextCsvPipeChunk(CsvPipe *pipe, char **chunk) {
+    if (!pipe->threaded) {
+        *chunk = pipe->slots[0];
+        return readCsvSource(pipe->source, pipe->slots[0], CSV_CHUNK_SIZE);
+    }
+
+    pthread_mutex_lock(&pipe->lock);
+    if (pipe->acquired) {
+        // Devolve ao produtor o bloco consumido na chamada anterior
+        pipe->head = (pipe->head + 1) % CSV_PIPE_SLOTS;
+        pipe->count--;
+        pipe->acquired = 0;
+        pthread_cond_signal(&pipe->notFull);
+    }
+    while (pipe->count == 0 && !pipe->done) {
+        pthread_cond_wait(&pipe->notEmpty, &pipe->lock);
+    }
+
+    long length;
+    if (pipe->count > 0) {
+        *chunk = pipe->slots[pipe->head];
+        length = pipe->lengths[pipe->head];
+        pipe->acquired = 1;
     } else {
-        selectedCols = splitString(selectedColumns, ",", &selectedCount);
+        length = pipe->failed ? -1 : 0;
     }
+    pthread_mutex_unlock(&pipe->lock);
+    return length;
+}
 
-    char errorBuffer[1024] = {0};
-    validateHeadersAndFilters(selectedColumns, rowFilterDefinitions, headers, headerCount, errorBuffer);
+// Interrompe o produtor, se houver, e libera os blocos
+void closeCsvPipe(CsvPipe *pipe) {
+    if (pipe->threaded) {
+        pthread_mutex_lock(&pipe->lock);
+        pipe->cancelled = 1;
+        pthread_cond_signal(&pipe->notFull);
+        pthread_mutex_unlock(&pipe->lock);
+        pthread_join(pipe->producer, NULL);
+    }
+    if (pipe->syncReady) {
+        pthread_cond_destroy(&pipe->notFull);
+        pthread_cond_destroy(&pipe->notEmpty);
+        pthread_mutex_destroy(&pipe->lock);
+    }
+    for (int i = 0; i < CSV_PIPE_SLOTS; i++) {
+        free(pipe->slots[i]);
+    }
+    memset(pipe, 0, sizeof(CsvPipe));
+}
 
-    if (strlen(errorBuffer) > 0) {
-        fprintf(stderr, "%s", errorBuffer);
-        freeSplitString(rows, rowCount);
-        freeSplitString(headers, headerCount);
-        if (selectedCols != headers) freeSplitString(selectedCols, selectedCount);
+// Função para processar um arquivo CSV, comprimido (gzip/zstd) ou não, em blocos de tamanho fixo
+void processCsvFile(const char csvFilePath[], const char selectedColumns[], const char rowFilterDefinitions[]) {
+    pthread_mutex_lock(&mutex);
+
+    CsvSource source;
+    if (!openCsvSource(&source, csvFilePath)) {
         pthread_mutex_unlock(&mutex);
         return;
     }
 
-    Filter *filters = extractFilters(rowFilterDefinitions, headers, headerCount, &filterCount);
-    if (!filters) {
-        freeSplitString(rows, rowCount);
-        freeSplitString(headers, headerCount);
-        if (selectedCols != headers) freeSplitString(selectedCols, selectedCount);
+    CsvPipe pipe;
+    if (!openCsvPipe(&pipe, &source)) {
+        closeCsvSource(&source);
         pthread_mutex_unlock(&mutex);
         return;
     }
 
-    // Imprime os headers selecionados na ordem do CSV
-    int printedHeaders = 0;
-    for (int j = 0; j < headerCount; j++) {
-        for (int k = 0; k < selectedCount; k++) {
-            if (strcmp(headers[j], selectedCols[k]) == 0) {
-                if (printedHeaders > 0) printf(",");
-                printf("%s", headers[j]);
-                printedHeaders++;
+    // Buffer da linha corrente; cresce apenas até o tamanho da maior linha do arquivo
+    size_t lineCapacity = 256, lineLength = 0;
+    char *line = (char *)malloc(lineCapacity);
+
+    CsvQuery query;
+    int headerRead = 0, queryReady = 0, stopped = !line;
+    long chunkLength = 0;
+    char *chunk;
+
+    while (!stopped) {
+        chunkLength = nextCsvPipeChunk(&pipe, &chunk);
+        // Em caso de erro a linha incompleta é descartada
+        if (chunkLength < 0) break;
+        // Um bloco vazio marca o fim do arquivo; a última linha pode não ter '\n'
+        int endOfFile = chunkLength == 0;
+        size_t position = 0;
+
+        while (!stopped && (position < (size_t)chunkLength || (endOfFile && lineLength > 0))) {
+            size_t remaining = endOfFile ? 0 : (size_t)chunkLength - position;
+            char *newline = remaining ? (char *)memchr(chunk + position, '\n', remaining) : NULL;
+            size_t length = newline ? (size_t)(newline - (chunk + position)) : remaining;
+
+            if (lineLength + length + 1 > lineCapacity) {
+                while (lineLength + length + 1 > lineCapacity) lineCapacity *= 2;
+                char *newLine = (char *)realloc(line, lineCapacity);
+                if (!newLine) {
+                    stopped = 1;
+                    break;
+                }
+                line = newLine;
+            }
+            memcpy(line + lineLength, chunk + position, length);
+            lineLength += length;
+            position += length;
+
+            if (!newline && !endOfFile) break;
+            if (newline) position++;
+
+            line[lineLength] = '\0';
+            // Linhas vazias são ignoradas, assim como em processCsv
+            if (lineLength > 0) {
+                if (!headerRead) {
+                    headerRead = 1;
+                    queryReady = beginCsvQuery(&query, line, selectedColumns, rowFilterDefinitions);
+                    stopped = !queryReady;
+                } else {
+                    processCsvRow(&query, line);
+                }
+            }
+            lineLength = 0;
+        }
+
+        if (endOfFile) break;
+    }
+
+    if (chunkLength < 0) {
+        fprintf(stderr, "Unable to read file '%s'\n", csvFilePath);
+    }
+
+    if (queryReady) endCsvQuery(&query);
+    free(line);
+    closeCsvPipe(&pipe);
+    closeCsvSource(&source);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+// Separa os campos de uma linha no próprio buffer, trocando as vírgulas por '\0'. Assim como em splitString, campos vazios são ignorados
+int splitFieldsInPlace(char *data, size_t start, size_t end, size_t *offsets, int maxFields) {
+    int count = 0;
+    size_t i = start;
+
+    while (i < end) {
+        while (i < end && (data[i] == ',' || data[i] == '\0')) data[i++] = '\0';
+        if (i >= end) break;
+
+        if (count < maxFields) offsets[count] = i;
+        count++;
+        while (i < end && data[i] != ',' && data[i] != '\0') i++;
+    }
+    return count;
+}
+
+// Monta a tabela a partir de um buffer terminado em '\0', do qual passa a ser dona
+CsvTable *buildCsvTable(char *data, size_t length) {
+    CsvTable *table = (CsvTable *)calloc(1, sizeof(CsvTable));
+    if (!table) {
+        free(data);
+        return NULL;
+    }
+    table->data = data;
+    table->length = length;
+    pthread_mutex_init(&table->lock, NULL);
+
+    // Conta as linhas para alocar todos os offsets de uma só vez
+    size_t lineCount = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] == '\n') lineCount++;
+    }
+
+    size_t position = 0;
+    while (position < length) {
+        char *newline = (char *)memchr(data + position, '\n', length - position);
+        size_t end = newline ? (size_t)(newline - data) : length;
+        if (newline) *newline = '\0';
+
+        // Linhas vazias são ignoradas, assim como em processCsv
+        if (end > position) {
+            if (!table->headers) {
+                int headerCount = splitFieldsInPlace(data, position, end, NULL, 0);
+                if (headerCount == 0) break;
+
+                table->headers = (char **)malloc((size_t)headerCount * sizeof(char *));
+                table->offsets = (size_t *)malloc((lineCount - 1) * (size_t)headerCount * sizeof(size_t) + 1);
+                table->numericColumns = (double **)calloc((size_t)headerCount, sizeof(double *));
+                if (!table->headers || !table->offsets || !table->numericColumns) break;
+
+                // Os campos já estão separados por '\0'; registra o início de cada um
+                for (size_t i = position; i < end; i++) {
+                    if (data[i] != '\0' && (i == position || data[i - 1] == '\0')) {
+                        table->headers[table->headerCount++] = data + i;
+                    }
+                }
+            } else {
+                size_t *row = table->offsets + (size_t)table->rowCount * (size_t)table->headerCount;
+                int fieldCount = splitFieldsInPlace(data, position, end, row, table->headerCount);
+
+                // Campos ausentes apontam para o '\0' final do buffer
+                for (int i = fieldCount; i < table->headerCount; i++) {
+                    row[i] = length;
+                }
+                table->rowCount++;
+            }
+        }
+        position = end + 1;
+    }
+
+    if (!table->headers || table->headerCount == 0 || !table->offsets || !table->numericColumns) {
+        csvTableFree(table);
+        return NULL;
+    }
+    return table;
+}
+
+// Carrega uma string CSV em uma tabela
+CsvTable *csvTableLoad(const char csv[]) {
+    size_t length = strlen(csv);
+    char *data = (char *)malloc(length + 1);
+    if (!data) return NULL;
+
+    memcpy(data, csv, length + 1);
+    return buildCsvTable(data, length);
+}
+
+// Carrega um arquivo CSV, comprimido (gzip/zstd) ou não, em uma tabela
+CsvTable *csvTableLoadFile(const char csvFilePath[]) {
+    CsvSource source;
+    if (!openCsvSource(&source, csvFilePath)) return NULL;
+
+    size_t capacity = CSV_CHUNK_SIZE, length = 0;
+    char *data = (char *)malloc(capacity + 1);
+    long chunkLength = 0;
+
+    while (data) {
+        if (capacity - length < CSV_CHUNK_SIZE) {
+            capacity *= 2;
+            char *newData = (char *)realloc(data, capacity + 1);
+            if (!newData) {
+                free(data);
+                data = NULL;
                 break;
             }
+            data = newData;
         }
+
+        chunkLength = readCsvSource(&source, data + length, CSV_CHUNK_SIZE);
+        if (chunkLength <= 0) break;
+        length += (size_t)chunkLength;
     }
-    printf("\n");
+    closeCsvSource(&source);
 
-    for (int i = 1; i < rowCount; i++) {
-        int rowColumnCount;
-        char **row = splitString(rows[i], ",", &rowColumnCount);
-        if (!rowMatchesFilters(headers, row, filters, filterCount, headerCount)) {
-            freeSplitString(row, rowColumnCount);
-            continue;
+    if (!data) return NULL;
+    if (chunkLength < 0) {
+        fprintf(stderr, "Unable to read file '%s'\n", csvFilePath);
+        free(data);
+        return NULL;
+    }
+
+    data[length] = '\0';
+    return buildCsvTable(data, length);
+}
+
+// Libera a tabela e as colunas numéricas já construídas
+void csvTableFree(CsvTable *table) {
+    if (!table) return;
+
+    if (table->numericColumns) {
+        for (int i = 0; i < table->headerCount; i++) {
+            free(table->numericColumns[i]);
         }
+        free(table->numericColumns);
+    }
+    pthread_mutex_destroy(&table->lock);
+    free(table->offsets);
+    free(table->headers);
+    free(table->data);
+    free(table);
+}
 
-        // Imprime os valores da linha na ordem dos headers, selecionados
-        int printedValues = 0;
-        for (int j = 0; j < headerCount; j++) {
-            for (int k = 0; k < selectedCount; k++) {
-                if (strcmp(headers[j], selectedCols[k]) == 0) {
-                    if (printedValues > 0) printf(",");
-                    printf("%s", row[j]);
-                    printedValues++;
-                    break;
-                }
+int csvTableRowCount(const CsvTable *table) {
+    return table->rowCount;
+}
+
+int csvTableColumnCount(const CsvTable *table) {
+    return table->headerCount;
+}
+
+const char *csvTableHeader(const CsvTable *table, int column) {
+    if (column < 0 || column >= table->headerCount) return NULL;
+    return table->headers[column];
+}
+
+const char *csvTableValue(const CsvTable *table, int row, int column) {
+    if (row < 0 || row >= table->rowCount || column < 0 || column >= table->headerCount) return NULL;
+    return table->data + table->offsets[(size_t)row * (size_t)table->headerCount + (size_t)column];
+}
+
+// Converte a coluna para números na primeira chamada; o mutex da tabela protege a construção entre threads
+const double *csvTableNumericColumn(CsvTable *table, int column) {
+    if (column < 0 || column >= table->headerCount) return NULL;
+
+    pthread_mutex_lock(&table->lock);
+    double *values = table->numericColumns[column];
+    if (!values) {
+        values = (double *)malloc((size_t)table->rowCount * sizeof(double) + 1);
+        if (values) {
+            for (int i = 0; i < table->rowCount; i++) {
+                const char *value = csvTableValue(table, i, column);
+                char *end;
+                double number = strtod(value, &end);
+                values[i] = (end != value && *end == '\0') ? number : NAN;
             }
+            table->numericColumns[column] = values;
         }
-        printf("\n");
-        freeSplitString(row, rowColumnCount);
     }
+    pthread_mutex_unlock(&table->lock);
+    return values;
+}
 
-    freeSplitString(rows, rowCount);
-    if (selectedCols != headers) freeSplitString(selectedCols, selectedCount);
-    freeSplitString(headers, headerCount);
-    freeFilters(filters, filterCount);
+// Valida colunas e filtros uma única vez para que a consulta possa ser executada várias vezes
+CsvTableQuery *csvTablePrepare(const CsvTable *table, const char selectedColumns[], const char rowFilterDefinitions[]) {
+    // splitString e extractFilters usam strtok, cujo estado é compartilhado entre threads
+    pthread_mutex_lock(&mutex);
+
+    char errorBuffer[1024] = {0};
+    validateHeadersAndFilters(selectedColumns, rowFilterDefinitions, table->headers, table->headerCount, errorBuffer);
+
+    if (strlen(errorBuffer) > 0) {
+        fprintf(stderr, "%s", errorBuffer);
+        pthread_mutex_unlock(&mutex);
+        return NULL;
+    }
+
+    CsvTableQuery *query = (CsvTableQuery *)calloc(1, sizeof(CsvTableQuery));
+    if (!query) {
+        pthread_mutex_unlock(&mutex);
+        return NULL;
+    }
+    query->table = table;
+
+    query->filters = extractFilters(rowFilterDefinitions, table->headers, table->headerCount, &query->filterCount);
+    query->columns = (int *)malloc((size_t)table->headerCount * sizeof(int));
+    if (!query->filters || !query->columns) {
+        csvTableQueryFree(query);
+        pthread_mutex_unlock(&mutex);
+        return NULL;
+    }
+
+    int selectedCount = 0;
+    char **selectedCols = NULL;
+    if (strlen(selectedColumns) > 0) {
+        selectedCols = splitString(selectedColumns, ",", &selectedCount);
+        if (!selectedCols) {
+            csvTableQueryFree(query);
+            pthread_mutex_unlock(&mutex);
+            return NULL;
+        }
+    }
+
+    // Colunas selecionadas na ordem do CSV
+    for (int j = 0; j < table->headerCount; j++) {
+        int selected = !selectedCols;
+        for (int k = 0; k < selectedCount && !selected; k++) {
+            selected = (strcmp(table->headers[j], selectedCols[k]) == 0);
+        }
+        if (selected) query->columns[query->columnCount++] = j;
+    }
+
+    if (selectedCols) freeSplitString(selectedCols, selectedCount);
     pthread_mutex_unlock(&mutex);
+    return query;
 }
 
-// Função para processar um arquivo CSV
-void processCsvFile(const char csvFilePath[], const char selectedColumns[], const char rowFilterDefinitions[]) {
-    FILE *file = fopen(csvFilePath, "r");
-    if (!file) {
-        perror("Unable to open file");
+// Executa a consulta: a filtragem só lê a tabela e roda em paralelo; apenas a impressão é serializada
+void csvTableRun(const CsvTableQuery *query) {
+    const CsvTable *table = query->table;
+
+    // columnMatches guarda o número da linha em que a coluna foi aceita, dispensando zerar o vetor a cada linha
+    int *columnMatches = (int *)calloc((size_t)table->headerCount, sizeof(int));
+    int *matchedRows = (int *)malloc((size_t)table->rowCount * sizeof(int) + 1);
+    if (!columnMatches || !matchedRows) {
+        free(columnMatches);
+        free(matchedRows);
         return;
     }
 
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    int matchedCount = 0;
+    for (int i = 0; i < table->rowCount; i++) {
+        const size_t *row = table->offsets + (size_t)i * (size_t)table->headerCount;
+        int stamp = i + 1;
 
-    char *fileContent = (char *)malloc((size_t)fileSize + 1);
-    if (!fileContent) {
-        fclose(file);
-        return;
+        for (int f = 0; f < query->filterCount; f++) {
+            int columnIndex = query->filters[f].columnIndex;
+            if (filterMatches(&query->filters[f], table->data + row[columnIndex]) > 0) {
+                columnMatches[columnIndex] = stamp;
+            }
+        }
+
+        // Verifique se todas as colunas têm pelo menos um filtro correspondente
+        int matched = 1;
+        for (int f = 0; f < query->filterCount && matched; f++) {
+            matched = (columnMatches[query->filters[f].columnIndex] == stamp);
+        }
+        if (matched) matchedRows[matchedCount++] = i;
     }
+    free(columnMatches);
 
-    fread(fileContent, 1, (size_t)fileSize, file);
-    fileContent[fileSize] = '\0';
-    fclose(file);
+    pthread_mutex_lock(&mutex);
+    for (int k = 0; k < query->columnCount; k++) {
+        if (k > 0) putchar(',');
+        fputs(table->headers[query->columns[k]], stdout);
+    }
+    putchar('\n');
+
+    for (int m = 0; m < matchedCount; m++) {
+        const size_t *row = table->offsets + (size_t)matchedRows[m] * (size_t)table->headerCount;
+        for (int k = 0; k < query->columnCount; k++) {
+            if (k > 0) putchar(',');
+            fputs(table->data + row[query->columns[k]], stdout);
+        }
+        putchar('\n');
+    }
+    pthread_mutex_unlock(&mutex);
+
+    free(matchedRows);
+}
 
-    processCsv(fileContent, selectedColumns, rowFilterDefinitions);
+// Libera a consulta preparada
+void csvTableQueryFree(CsvTableQuery *query) {
+    if (!query) return;
 
-    free(fileContent);
-}
\ No newline at end of file
+    if (query->filters) freeFilters(query->filters, query->filterCount);
+    free(query->columns);
+    free(query);
+}
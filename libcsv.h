@@ -12,6 +12,10 @@ void processCsv(const char[], const char[], const char[]);
 /**
  * Process the CSV data by applying filters and selecting columns.
  *
+ * Files compressed with gzip or zstd are detected by their magic bytes and
+ * decompressed in fixed-size chunks, so memory use does not grow with the
+ * file size.
+ *
  * @param csvFilePath The file path of the CSV to be processed.
  * @param selectedColumns The columns to be selected from the CSV data.
  * @param rowFilterDefinitions The filters to be applied to the CSV data.
@@ -19,3 +23,121 @@ void processCsv(const char[], const char[], const char[]);
  * @return void
  */
 void processCsvFile(const char[], const char[], const char[]);
+
+/**
+ * CSV data loaded once into memory so that several queries can run over it
+ * without parsing the text again.
+ *
+ * csvTablePrepare, csvTableRun and csvTableNumericColumn are safe to call
+ * concurrently from several threads on the same table. csvTableFree and
+ * csvTableQueryFree are not: call them only when no other thread is using
+ * the table or the query.
+ */
+typedef struct CsvTable CsvTable;
+
+/**
+ * Selected columns and filters validated against a CsvTable.
+ */
+typedef struct CsvTableQuery CsvTableQuery;
+
+/**
+ * Load the CSV data into a table. Fields are split the same way as in
+ * processCsv.
+ *
+ * @param csv The CSV data to be loaded.
+ *
+ * @return The table, or NULL if the data has no header or memory runs out.
+ */
+CsvTable *csvTableLoad(const char[]);
+
+/**
+ * Load a CSV file, compressed with gzip/zstd or not, into a table.
+ *
+ * @param csvFilePath The file path of the CSV to be loaded.
+ *
+ * @return The table, or NULL on error.
+ */
+CsvTable *csvTableLoadFile(const char[]);
+
+/**
+ * Free the table. Its queries must be freed before it.
+ *
+ * @param table The table to be freed.
+ *
+ * @return void
+ */
+void csvTableFree(CsvTable *);
+
+/**
+ * @param table The table.
+ *
+ * @return The number of data rows, not counting the header.
+ */
+int csvTableRowCount(const CsvTable *);
+
+/**
+ * @param table The table.
+ *
+ * @return The number of columns in the header.
+ */
+int csvTableColumnCount(const CsvTable *);
+
+/**
+ * @param table The table.
+ * @param column The column index.
+ *
+ * @return The header of the column, or NULL if the index is out of range.
+ */
+const char *csvTableHeader(const CsvTable *, int);
+
+/**
+ * @param table The table.
+ * @param row The data row index.
+ * @param column The column index.
+ *
+ * @return The field value ("" for missing fields), or NULL if an index is out of range.
+ */
+const char *csvTableValue(const CsvTable *, int, int);
+
+/**
+ * Return the column converted to numbers. The vector is built on the first
+ * call and kept in the table; fields that are not numbers become NAN.
+ *
+ * @param table The table.
+ * @param column The column index.
+ *
+ * @return The vector with csvTableRowCount values, or NULL on error.
+ */
+const double *csvTableNumericColumn(CsvTable *, int);
+
+/**
+ * Validate the selected columns and filters against the table, reporting
+ * errors on stderr like processCsv.
+ *
+ * @param table The table to be queried.
+ * @param selectedColumns The columns to be selected from the table.
+ * @param rowFilterDefinitions The filters to be applied to the table.
+ *
+ * @return The prepared query, or NULL on error.
+ */
+CsvTableQuery *csvTablePrepare(const CsvTable *, const char[], const char[]);
+
+/**
+ * Run the prepared query, printing the result like processCsv. Safe to call
+ * concurrently with csvTablePrepare, csvTableRun and csvTableNumericColumn;
+ * each result is printed without interleaving with other output.
+ *
+ * @param query The query to be run.
+ *
+ * @return void
+ */
+void csvTableRun(const CsvTableQuery *);
+
+/**
+ * Free the prepared query.
+ *
+ * @param query The query to be freed.
+ *
+ * @return void
+ */
+void csvTableQueryFree(CsvTableQuery *);
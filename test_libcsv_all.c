@@ -2,10 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <zstd.h>
 #include <CUnit/Basic.h>
 #include "libcsv.h"
 
 #define TEMP_FILE "temp_stderr.txt"
+#define LARGE_FILE "temp_large.csv"
+#define LARGE_ROWS 20000
 
 // Função de setup
 int init_suite(void) { return 0; }
@@ -269,6 +274,266 @@ void test_processCsvFile_operators(void) {
     CU_ASSERT_STRING_EQUAL(output, "col1,col3\nl2c1,l2c3\nl3c1,l3c3\n");
 }
 
+// Teste para arquivo comprimido com gzip em processCsvFile
+void test_processCsvFile_gzip(void) {
+    const char *csvFilePath = "data.csv.gz";
+    char output[1024] = {0};
+    redirect_stdout(output);
+    processCsvFile(csvFilePath, "col1,col3,col4,col7", "col1>l1c1\ncol3>l1c3");
+    restore_stdout();
+    CU_ASSERT_STRING_EQUAL(output, "col1,col3,col4,col7\nl2c1,l2c3,l2c4,l2c7\nl3c1,l3c3,l3c4,l3c7\n");
+}
+
+// Teste para arquivo comprimido com zstd em processCsvFile
+void test_processCsvFile_zstd(void) {
+    const char *csvFilePath = "data.csv.zst";
+    char output[1024] = {0};
+    redirect_stdout(output);
+    processCsvFile(csvFilePath, "col1,col3,col4,col7", "col1>l1c1\ncol3>l1c3");
+    restore_stdout();
+    CU_ASSERT_STRING_EQUAL(output, "col1,col3,col4,col7\nl2c1,l2c3,l2c4,l2c7\nl3c1,l3c3,l3c4,l3c7\n");
+}
+
+// Teste básico para CsvTable: o resultado deve ser o mesmo de processCsv
+void test_csvTable_basic(void) {
+    const char csv[] = "header1,header2,header3\n1,2,3\n4,5,6\n7,8,9";
+    char output[1024] = {0};
+    CsvTable *table = csvTableLoad(csv);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+    CU_ASSERT_EQUAL(csvTableRowCount(table), 3);
+    CU_ASSERT_EQUAL(csvTableColumnCount(table), 3);
+    CU_ASSERT_STRING_EQUAL(csvTableValue(table, 1, 2), "6");
+
+    CsvTableQuery *query = csvTablePrepare(table, "header3,header1", "header1>1\nheader3<9");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(query);
+    redirect_stdout(output);
+    csvTableRun(query);
+    restore_stdout();
+    CU_ASSERT_STRING_EQUAL(output, "header1,header3\n4,6\n");
+
+    csvTableQueryFree(query);
+    csvTableFree(table);
+}
+
+// Teste para várias consultas preparadas sobre a mesma tabela
+void test_csvTable_repeated_queries(void) {
+    char output[1024] = {0};
+    CsvTable *table = csvTableLoadFile("data.csv.gz");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    CsvTableQuery *first = csvTablePrepare(table, "col1,col3", "col1!=l1c1\ncol2>=l2c2\ncol3<=l3c3");
+    CsvTableQuery *second = csvTablePrepare(table, "col4,col1", "col1>l1c1\ncol3>l1c3");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(first);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(second);
+    redirect_stdout(output);
+    csvTableRun(first);
+    csvTableRun(second);
+    csvTableRun(first);
+    restore_stdout();
+    CU_ASSERT_STRING_EQUAL(output, "col1,col3\nl2c1,l2c3\nl3c1,l3c3\ncol1,col4\nl2c1,l2c4\nl3c1,l3c4\ncol1,col3\nl2c1,l2c3\nl3c1,l3c3\n");
+
+    csvTableQueryFree(first);
+    csvTableQueryFree(second);
+    csvTableFree(table);
+}
+
+// Teste para consulta com colunas inexistentes em CsvTable
+void test_csvTable_nonexistent_columns(void) {
+    char error_output[1024] = {0};
+    CsvTable *table = csvTableLoad("header1,header2,header3\n1,2,3");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+    int saved_stderr = dup(fileno(stderr));
+    redirect_stderr(TEMP_FILE);
+
+    CsvTableQuery *query = csvTablePrepare(table, "header4", "header1>1");
+
+    restore_stderr(saved_stderr);
+    FILE *file = fopen(TEMP_FILE, "r");
+    fread(error_output, sizeof(char), sizeof(error_output) - 1, file);
+    fclose(file);
+    remove(TEMP_FILE);
+
+    CU_ASSERT_PTR_NULL(query);
+    CU_ASSERT_STRING_EQUAL(error_output, "Header 'header4' not found in CSV file/string\n");
+    csvTableFree(table);
+}
+
+// Teste para colunas numéricas construídas sob demanda
+void test_csvTable_numeric_column(void) {
+    CsvTable *table = csvTableLoad("id,name\n10,a\n2.5,b\nx,c");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    const double *values = csvTableNumericColumn(table, 0);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(values);
+    CU_ASSERT_DOUBLE_EQUAL(values[0], 10.0, 0.0001);
+    CU_ASSERT_DOUBLE_EQUAL(values[1], 2.5, 0.0001);
+    CU_ASSERT(values[2] != values[2]);
+    CU_ASSERT_PTR_EQUAL(csvTableNumericColumn(table, 0), values);
+    CU_ASSERT_PTR_NULL(csvTableNumericColumn(table, 2));
+
+    csvTableFree(table);
+}
+
+// Função auxiliar que gera um CSV de ~780 KiB (mais de 4 blocos de 64 KiB). Cada linha tem 39 bytes
+// e o cabeçalho 15, então o limite de 65536 bytes cai no meio da linha 001680
+char *build_large_csv(size_t *length) {
+    char *csv = (char *)malloc(16 + (size_t)LARGE_ROWS * 39 + 1);
+    size_t position = (size_t)sprintf(csv, "id,payload,key\n");
+    for (int i = 0; i < LARGE_ROWS; i++) {
+        position += (size_t)sprintf(csv + position, "%06d,payload-payload-payload,%06d\n", i, i % 1000);
+    }
+    *length = position;
+    return csv;
+}
+
+// Função auxiliar que grava o CSV grande em arquivo; gzipMembers > 0 divide o conteúdo em membros gzip concatenados
+void write_large_file(const char *path, const char *csv, size_t length, int gzipMembers) {
+    if (gzipMembers > 0) {
+        size_t memberLength = length / (size_t)gzipMembers + 1;
+        for (size_t offset = 0; offset < length; offset += memberLength) {
+            gzFile gz = gzopen(path, offset == 0 ? "wb" : "ab");
+            size_t remaining = length - offset < memberLength ? length - offset : memberLength;
+            gzwrite(gz, csv + offset, (unsigned)remaining);
+            gzclose(gz);
+        }
+        return;
+    }
+
+    FILE *file = fopen(path, "wb");
+    fwrite(csv, 1, length, file);
+    fclose(file);
+}
+
+// Teste para arquivos grandes (plano, gzip com vários membros e zstd) com linhas atravessando blocos
+void test_processCsvFile_large(void) {
+    const char *expected = "id,key\n001680,000680\n019999,000999\n";
+    size_t length;
+    char *csv = build_large_csv(&length);
+
+    for (int format = 0; format < 3; format++) {
+        if (format == 2) {
+            size_t capacity = ZSTD_compressBound(length);
+            char *compressed = (char *)malloc(capacity);
+            size_t compressedLength = ZSTD_compress(compressed, capacity, csv, length, 3);
+            write_large_file(LARGE_FILE, compressed, compressedLength, 0);
+            free(compressed);
+        } else {
+            write_large_file(LARGE_FILE, csv, length, format == 1 ? 3 : 0);
+        }
+
+        char output[1024] = {0};
+        redirect_stdout(output);
+        processCsvFile(LARGE_FILE, "id,key", "id=001680\nid=019999");
+        restore_stdout();
+        CU_ASSERT_STRING_EQUAL(output, expected);
+    }
+
+    remove(LARGE_FILE);
+    free(csv);
+}
+
+// Teste para arquivo gzip truncado em processCsvFile
+void test_processCsvFile_truncated_gzip(void) {
+    size_t length;
+    char *csv = build_large_csv(&length);
+    write_large_file(LARGE_FILE, csv, length, 1);
+    free(csv);
+
+    // Mantém apenas metade do arquivo comprimido
+    FILE *file = fopen(LARGE_FILE, "rb");
+    fseek(file, 0, SEEK_END);
+    long compressedLength = ftell(file);
+    fclose(file);
+    truncate(LARGE_FILE, compressedLength / 2);
+
+    char output[1024] = {0};
+    char error_output[1024] = {0};
+    int saved_stderr = dup(fileno(stderr));
+    redirect_stderr(TEMP_FILE);
+    redirect_stdout(output);
+
+    processCsvFile(LARGE_FILE, "id,key", "id=019999");
+
+    restore_stdout();
+    restore_stderr(saved_stderr);
+    file = fopen(TEMP_FILE, "r");
+    fread(error_output, sizeof(char), sizeof(error_output) - 1, file);
+    fclose(file);
+    remove(TEMP_FILE);
+    remove(LARGE_FILE);
+
+    CU_ASSERT_STRING_EQUAL(output, "id,key\n");
+    CU_ASSERT_STRING_EQUAL(error_output, "Unable to read file '" LARGE_FILE "'\n");
+}
+
+#define TABLE_THREADS 8
+#define TABLE_THREAD_QUERIES 200
+#define TABLE_COLUMNS 200
+
+// Dados compartilhados pelas threads de test_csvTable_threads
+typedef struct {
+    CsvTable *table;
+    const char *filters;
+    int failures;
+} TableThreadArgs;
+
+// Função auxiliar executada por cada thread: prepara várias consultas sobre a mesma tabela e executa a última
+void *table_thread_worker(void *arg) {
+    TableThreadArgs *args = (TableThreadArgs *)arg;
+    CsvTableQuery *query = NULL;
+    for (int i = 0; i < TABLE_THREAD_QUERIES; i++) {
+        csvTableQueryFree(query);
+        query = csvTablePrepare(args->table, "c0,c199", args->filters);
+        const double *values = csvTableNumericColumn(args->table, i % TABLE_COLUMNS);
+        if (!query || !values || values[0] != 1.0) args->failures++;
+    }
+    if (query) csvTableRun(query);
+    csvTableQueryFree(query);
+    return NULL;
+}
+
+// Teste para várias threads preparando e executando consultas sobre a mesma tabela
+void test_csvTable_threads(void) {
+    char csv[4096] = {0};
+    char filters[4096] = {0};
+    for (int i = 0; i < TABLE_COLUMNS; i++) {
+        sprintf(csv + strlen(csv), "%sc%d", i > 0 ? "," : "", i);
+        sprintf(filters + strlen(filters), "%sc%d>=0", i > 0 ? "\n" : "", i);
+    }
+    strcat(csv, "\n");
+    for (int i = 0; i < TABLE_COLUMNS; i++) {
+        strcat(csv, i > 0 ? ",1" : "1");
+    }
+
+    CsvTable *table = csvTableLoad(csv);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    char output[1024] = {0};
+    pthread_t threads[TABLE_THREADS];
+    TableThreadArgs args[TABLE_THREADS];
+    redirect_stdout(output);
+    for (int i = 0; i < TABLE_THREADS; i++) {
+        args[i].table = table;
+        args[i].filters = filters;
+        args[i].failures = 0;
+        pthread_create(&threads[i], NULL, table_thread_worker, &args[i]);
+    }
+    for (int i = 0; i < TABLE_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        CU_ASSERT_EQUAL(args[i].failures, 0);
+    }
+    restore_stdout();
+
+    // Cada execução imprime seu resultado inteiro, sem se misturar com as demais
+    char expected[1024] = {0};
+    for (int i = 0; i < TABLE_THREADS; i++) {
+        strcat(expected, "c0,c199\n1,1\n");
+    }
+    CU_ASSERT_STRING_EQUAL(output, expected);
+
+    csvTableFree(table);
+}
+
 int main() {
     CU_initialize_registry();
     CU_pSuite suite = CU_add_suite("Suite_ProcessCSV", init_suite, clean_suite);
@@ -290,6 +555,15 @@ int main() {
     CU_add_test(suite, "test of processCsvFile_invalid_filters", test_processCsvFile_invalid_filters);
     CU_add_test(suite, "test of processCsvFile_operators", test_processCsvFile_operators);
     CU_add_test(suite, "test of processCsvFile_quoted_headers", test_processCsvFile_quoted_headers);
+    CU_add_test(suite, "test of processCsvFile_gzip", test_processCsvFile_gzip);
+    CU_add_test(suite, "test of processCsvFile_zstd", test_processCsvFile_zstd);
+    CU_add_test(suite, "test of processCsvFile_large", test_processCsvFile_large);
+    CU_add_test(suite, "test of processCsvFile_truncated_gzip", test_processCsvFile_truncated_gzip);
+    CU_add_test(suite, "test of csvTable_basic", test_csvTable_basic);
+    CU_add_test(suite, "test of csvTable_repeated_queries", test_csvTable_repeated_queries);
+    CU_add_test(suite, "test of csvTable_nonexistent_columns", test_csvTable_nonexistent_columns);
+    CU_add_test(suite, "test of csvTable_numeric_column", test_csvTable_numeric_column);
+    CU_add_test(suite, "test of csvTable_threads", test_csvTable_threads);
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();